@@ -0,0 +1,212 @@
+#include "batch.h"
+#include "checksum.h"
+#include "utils.h"
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace fs = filesystem;
+
+// Запись манифеста: исходный файл и параметры, с которыми он был зашифрован
+struct ManifestEntry {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint32_t hash = 0;
+    string cipher;
+    string keyLabel;
+};
+
+static const char MANIFEST_HEADER[] = "# encryption manifest v1";
+
+static string toHex(uint32_t value) {
+    char buffer[9];
+    snprintf(buffer, sizeof(buffer), "%08x", value);
+    return buffer;
+}
+
+// Загрузка манифеста. Строка: размер, mtime, хеш, шифр, метка ключа, путь (через табуляцию).
+// Путь стоит последним, чтобы допускать табуляцию в имени файла
+static map<string, ManifestEntry> loadManifest(const fs::path& path) {
+    map<string, ManifestEntry> manifest;
+    ifstream in(path);
+    if (!in) return manifest;
+
+    string line;
+    while (getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        istringstream fields(line);
+        ManifestEntry entry;
+        string hash, relative;
+        if (!(fields >> entry.size >> entry.mtime >> hash >> entry.cipher >> entry.keyLabel)) continue;
+        fields.get();
+        getline(fields, relative);
+        if (relative.empty()) continue;
+        // Повреждённая строка пропускается: файл будет зашифрован заново
+        try {
+            entry.hash = static_cast<uint32_t>(stoul(hash, nullptr, 16));
+        } catch (const exception&) {
+            continue;
+        }
+        manifest[relative] = entry;
+    }
+    return manifest;
+}
+
+// Сохранение манифеста через временный файл, чтобы прерванный запуск не испортил старый
+static void saveManifest(const fs::path& path, const map<string, ManifestEntry>& manifest) {
+    fs::path tempPath = path;
+    tempPath += ".tmp";
+    {
+        ofstream out(tempPath, ios::trunc);
+        if (!out) throw runtime_error("Не удалось записать манифест");
+        out << MANIFEST_HEADER << "\n";
+        for (const auto& [relative, entry] : manifest) {
+            out << entry.size << '\t' << entry.mtime << '\t' << toHex(entry.hash) << '\t'
+                << entry.cipher << '\t' << entry.keyLabel << '\t' << relative << "\n";
+        }
+        if (!out) throw runtime_error("Не удалось записать манифест");
+    }
+    fs::rename(tempPath, path);
+}
+
+// Результат обработки одного файла
+enum class BatchStatus {
+    Unchanged,
+    Processed,
+    Failed
+};
+
+struct BatchItem {
+    fs::path source;
+    string relative;
+    ManifestEntry entry;
+    BatchStatus status = BatchStatus::Failed;
+    string error;
+};
+
+static void processItem(BatchItem& item, const BatchOptions& options,
+                        const map<string, ManifestEntry>& manifest, const BatchEncryptFunc& encrypt) {
+    fs::path target = fs::path(options.outputDir) / (item.relative + ".enc");
+    item.entry.size = fs::file_size(item.source);
+    item.entry.mtime = fs::last_write_time(item.source).time_since_epoch().count();
+    item.entry.cipher = options.cipherName;
+    item.entry.keyLabel = options.keyLabel;
+
+    auto previous = manifest.find(item.relative);
+    bool sameParams = previous != manifest.end() && previous->second.cipher == options.cipherName &&
+                      previous->second.keyLabel == options.keyLabel && previous->second.size == item.entry.size &&
+                      fs::exists(target);
+
+    // Размер и время изменения совпадают — файл не читается
+    if (sameParams && previous->second.mtime == item.entry.mtime) {
+        item.entry.hash = previous->second.hash;
+        item.status = BatchStatus::Unchanged;
+        return;
+    }
+
+    ifstream in(item.source, ios::binary);
+    if (!in) throw runtime_error("Не удалось открыть файл");
+    ostringstream buffer;
+    buffer << in.rdbuf();
+    string data = buffer.str();
+    item.entry.size = data.size();
+    item.entry.hash = crc32c(data);
+
+    // Файл перезаписан тем же содержимым — обновляется только mtime в манифесте
+    if (sameParams && previous->second.hash == item.entry.hash) {
+        item.status = BatchStatus::Unchanged;
+        return;
+    }
+
+    string output;
+    if (!encrypt(data, output)) throw runtime_error("Не удалось зашифровать файл");
+
+    error_code ec;
+    fs::create_directories(target.parent_path(), ec);
+    if (!fs::is_directory(target.parent_path())) throw runtime_error("Не удалось создать каталог результата");
+
+    // Результат пишется во временный файл: прерванный запуск не портит прежний шифротекст
+    fs::path tempPath = target;
+    tempPath += ".tmp";
+    {
+        ofstream out(tempPath, ios::binary | ios::trunc);
+        if (!out) throw runtime_error("Не удалось создать файл '" + tempPath.string() + "'");
+        out << output;
+        out.close();
+        if (!out) {
+            fs::remove(tempPath, ec);
+            throw runtime_error("Ошибка записи файла '" + tempPath.string() + "'");
+        }
+    }
+    fs::rename(tempPath, target, ec);
+    if (ec) {
+        fs::remove(tempPath, ec);
+        throw runtime_error("Не удалось заменить файл '" + target.string() + "'");
+    }
+    item.status = BatchStatus::Processed;
+}
+
+size_t runIncrementalBatch(const BatchOptions& options, const BatchEncryptFunc& encrypt) {
+    fs::path sourceDir = fs::canonical(options.sourceDir);
+    fs::create_directories(options.outputDir);
+    fs::path outputDir = fs::canonical(options.outputDir);
+    fs::path manifestPath = outputDir / MANIFEST_FILENAME;
+    map<string, ManifestEntry> manifest = loadManifest(manifestPath);
+
+    // Список файлов; каталог результата внутри исходного пропускается
+    vector<BatchItem> items;
+    for (auto it = fs::recursive_directory_iterator(sourceDir); it != fs::recursive_directory_iterator(); ++it) {
+        if (it->is_directory() && fs::equivalent(it->path(), outputDir)) {
+            it.disable_recursion_pending();
+            continue;
+        }
+        if (!it->is_regular_file()) continue;
+        BatchItem item;
+        item.source = it->path();
+        item.relative = fs::relative(it->path(), sourceDir).generic_string();
+        if (item.relative.find('\n') != string::npos) {
+            cerr << "Ошибка: имя файла содержит перевод строки, файл пропущен: " << item.relative << "\n";
+            continue;
+        }
+        items.push_back(item);
+    }
+
+    // Проверка, хеширование и шифрование файлов параллельно
+    parallelFor(items.size(), [&](size_t index) {
+        BatchItem& item = items[index];
+        try {
+            processItem(item, options, manifest, encrypt);
+        } catch (const exception& e) {
+            item.status = BatchStatus::Failed;
+            item.error = e.what();
+        }
+    });
+
+    // Новый манифест: удалённые исходные файлы из него выпадают, результаты остаются на диске
+    map<string, ManifestEntry> updated;
+    size_t processed = 0, unchanged = 0, failed = 0;
+    for (const BatchItem& item : items) {
+        switch (item.status) {
+            case BatchStatus::Processed:
+                cout << "Зашифрован: " << item.relative << "\n";
+                ++processed;
+                updated[item.relative] = item.entry;
+                break;
+            case BatchStatus::Unchanged:
+                ++unchanged;
+                updated[item.relative] = item.entry;
+                break;
+            case BatchStatus::Failed:
+                cerr << "Ошибка: " << item.relative << ": " << item.error << "\n";
+                ++failed;
+                break;
+        }
+    }
+    saveManifest(manifestPath, updated);
+
+    cout << "Зашифровано: " << processed << ", без изменений: " << unchanged
+         << ", ошибок: " << failed << "\n";
+    return failed;
+}
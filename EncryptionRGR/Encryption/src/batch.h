@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+
+using namespace std;
+
+// Параметры пакетной обработки каталога
+struct BatchOptions {
+    string sourceDir;
+    string outputDir;
+    string cipherName;
+    string keyLabel;  // Метка ключа, заданная пользователем (ключ и его производные в манифест не пишутся)
+};
+
+// Функция шифрования содержимого одного файла
+using BatchEncryptFunc = function<bool(const string& input, string& output)>;
+
+// Имя файла манифеста в каталоге результата
+const char* const MANIFEST_FILENAME = ".encryption_manifest";
+
+// Инкрементальная обработка: файлы, не изменившиеся с прошлого запуска
+// (по манифесту), пропускаются. Возвращает число файлов с ошибками
+size_t runIncrementalBatch(const BatchOptions& options, const BatchEncryptFunc& encrypt);
@@ -0,0 +1,78 @@
+#include "checksum.h"
+#include "tuning.h"
+#include <cstring>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <nmmintrin.h>
+#define CRC32C_HAS_SSE42 1
+#endif
+
+// Отражённый полином CRC32C
+static const uint32_t CRC32C_POLY = 0x82F63B78;
+
+// Таблица для программного вычисления
+static const uint32_t* softwareTable() {
+    static uint32_t table[256];
+    static bool initialized = [] {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int k = 0; k < 8; ++k) {
+                crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+            }
+            table[i] = crc;
+        }
+        return true;
+    }();
+    (void)initialized;
+    return table;
+}
+
+static uint32_t crc32cSoftware(uint32_t crc, const char* data, size_t size) {
+    const uint32_t* table = softwareTable();
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef CRC32C_HAS_SSE42
+// Аппаратное вычисление: 8 байт за инструкцию
+__attribute__((target("sse4.2")))
+static uint32_t crc32cHardware(uint32_t crc, const char* data, size_t size) {
+    size_t i = 0;
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t chunk;
+        memcpy(&chunk, data + i, sizeof(chunk));
+        crc64 = _mm_crc32_u64(crc64, chunk);
+    }
+    crc = static_cast<uint32_t>(crc64);
+#endif
+    for (; i < size; ++i) {
+        crc = _mm_crc32_u8(crc, static_cast<unsigned char>(data[i]));
+    }
+    return crc;
+}
+#endif
+
+bool crc32cHardwareAvailable() {
+#ifdef CRC32C_HAS_SSE42
+    static const bool available = __builtin_cpu_supports("sse4.2");
+    return available;
+#else
+    return false;
+#endif
+}
+
+// Продолжение вычисления: crc — результат предыдущего вызова (0 для начала)
+uint32_t crc32cUpdate(uint32_t crc, const char* data, size_t size) {
+    crc = ~crc;
+#ifdef CRC32C_HAS_SSE42
+    if (tuningProfile().hardwareCrc && crc32cHardwareAvailable()) return ~crc32cHardware(crc, data, size);
+#endif
+    return ~crc32cSoftware(crc, data, size);
+}
+
+uint32_t crc32c(const string& data) {
+    return crc32cUpdate(0, data.data(), data.size());
+}
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+// Контрольная сумма CRC32C (полином Кастаньоли)
+uint32_t crc32cUpdate(uint32_t crc, const char* data, size_t size);
+uint32_t crc32c(const string& data);
+
+// Используется ли аппаратная инструкция crc32 (SSE4.2)
+bool crc32cHardwareAvailable();
@@ -0,0 +1,211 @@
+#include "compression.h"
+#include "utils.h"
+#include "tuning.h"
+#include <cstring>
+#include <vector>
+
+// Параметры LZ-кодека
+static const size_t MIN_MATCH = 4;
+static const size_t MAX_OFFSET = 65535;
+static const int HASH_BITS = 16;
+
+// Режимы хранения блока
+static const unsigned char BLOCK_STORED = 0;
+static const unsigned char BLOCK_LZ = 1;
+
+// Заголовок блока: исходный размер, размер данных, режим
+static const size_t BLOCK_HEADER_SIZE = 9;
+
+static uint32_t read32(const char* p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t hashSequence(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Запись длины: 4 бита в токене, остаток байтами по 255
+static void appendLength(string& out, size_t length) {
+    while (length >= 255) {
+        out += static_cast<char>(255);
+        length -= 255;
+    }
+    out += static_cast<char>(length);
+}
+
+static void appendSequence(string& out, const char* literals, size_t literalCount,
+                           size_t offset, size_t matchLength) {
+    size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+    unsigned char token = static_cast<unsigned char>((min<size_t>(literalCount, 15) << 4) |
+                                                     min<size_t>(matchCode, 15));
+    out += static_cast<char>(token);
+    if (literalCount >= 15) appendLength(out, literalCount - 15);
+    out.append(literals, literalCount);
+    if (matchLength == 0) return; // Последняя последовательность — только литералы
+
+    out += static_cast<char>(offset & 0xFF);
+    out += static_cast<char>((offset >> 8) & 0xFF);
+    if (matchCode >= 15) appendLength(out, matchCode - 15);
+}
+
+// Сжатие одного блока
+static string lzCompressBlock(const char* src, size_t size) {
+    string out;
+    out.reserve(size / 2 + 16);
+    vector<int32_t> table(1 << HASH_BITS, -1);
+    size_t anchor = 0;
+    size_t i = 0;
+
+    while (i + MIN_MATCH <= size) {
+        uint32_t sequence = read32(src + i);
+        uint32_t h = hashSequence(sequence);
+        int32_t ref = table[h];
+        table[h] = static_cast<int32_t>(i);
+
+        if (ref < 0 || i - ref > MAX_OFFSET || read32(src + ref) != sequence) {
+            ++i;
+            continue;
+        }
+
+        size_t length = MIN_MATCH;
+        while (i + length < size && src[ref + length] == src[i + length]) ++length;
+
+        appendSequence(out, src + anchor, i - anchor, i - ref, length);
+        i += length;
+        anchor = i;
+    }
+
+    appendSequence(out, src + anchor, size - anchor, 0, 0);
+    return out;
+}
+
+static size_t readLength(const string& data, size_t& pos, size_t end) {
+    size_t length = 0;
+    unsigned char b;
+    do {
+        if (pos >= end) throw runtime_error("Повреждённые сжатые данные");
+        b = static_cast<unsigned char>(data[pos++]);
+        length += b;
+    } while (b == 255);
+    return length;
+}
+
+// Распаковка одного блока в заранее выделенный буфер
+static void lzDecompressBlock(const string& data, size_t pos, size_t end, char* dst, size_t rawSize) {
+    size_t written = 0;
+    while (true) {
+        if (pos >= end) throw runtime_error("Повреждённые сжатые данные");
+        unsigned char token = static_cast<unsigned char>(data[pos++]);
+
+        size_t literalCount = token >> 4;
+        if (literalCount == 15) literalCount += readLength(data, pos, end);
+        if (literalCount > end - pos || literalCount > rawSize - written) {
+            throw runtime_error("Повреждённые сжатые данные");
+        }
+        memcpy(dst + written, data.data() + pos, literalCount);
+        pos += literalCount;
+        written += literalCount;
+        if (pos == end) break;
+
+        if (end - pos < 2) throw runtime_error("Повреждённые сжатые данные");
+        size_t offset = static_cast<unsigned char>(data[pos]) |
+                        (static_cast<size_t>(static_cast<unsigned char>(data[pos + 1])) << 8);
+        pos += 2;
+        size_t length = token & 0x0F;
+        if (length == 15) length += readLength(data, pos, end);
+        length += MIN_MATCH;
+
+        if (offset == 0 || offset > written || length > rawSize - written) {
+            throw runtime_error("Повреждённые сжатые данные");
+        }
+        // Побайтовое копирование: источник может перекрываться с приёмником
+        for (size_t k = 0; k < length; ++k, ++written) {
+            dst[written] = dst[written - offset];
+        }
+    }
+    if (written != rawSize) throw runtime_error("Повреждённые сжатые данные");
+}
+
+// Сжатие: данные делятся на блоки, каждый блок сжимается в своём потоке
+string compressData(const string& data, CompressionType type) {
+    if (type == CompressionType::None) return data;
+
+    const size_t chunkSize = tuningProfile().compressionChunkSize;
+    size_t chunkCount = (data.size() + chunkSize - 1) / chunkSize;
+    vector<string> chunks(chunkCount);
+    parallelFor(chunkCount, [&](size_t index) {
+        size_t offset = index * chunkSize;
+        size_t size = min(chunkSize, data.size() - offset);
+        string compressed = lzCompressBlock(data.data() + offset, size);
+
+        string& chunk = chunks[index];
+        appendUint32(chunk, static_cast<uint32_t>(size));
+        if (compressed.size() < size) {
+            appendUint32(chunk, static_cast<uint32_t>(compressed.size()));
+            chunk += static_cast<char>(BLOCK_LZ);
+            chunk += compressed;
+        } else {
+            // Несжимаемый блок хранится как есть
+            appendUint32(chunk, static_cast<uint32_t>(size));
+            chunk += static_cast<char>(BLOCK_STORED);
+            chunk.append(data, offset, size);
+        }
+    }, tuningProfile().workerThreads);
+
+    string result;
+    size_t total = 0;
+    for (const string& chunk : chunks) total += chunk.size();
+    result.reserve(total);
+    for (const string& chunk : chunks) result += chunk;
+    return result;
+}
+
+// Распаковка: блоки независимы, поэтому тоже распаковываются параллельно
+string decompressData(const string& data, CompressionType type) {
+    if (type == CompressionType::None) return data;
+    if (type != CompressionType::LZ) throw invalid_argument("Неизвестный тип сжатия");
+
+    struct Block {
+        size_t inputPos;
+        size_t storedSize;
+        size_t outputPos;
+        size_t rawSize;
+        unsigned char mode;
+    };
+    vector<Block> blocks;
+    size_t pos = 0, total = 0;
+    while (pos < data.size()) {
+        if (data.size() - pos < BLOCK_HEADER_SIZE) throw runtime_error("Повреждённые сжатые данные");
+        Block block;
+        block.rawSize = readUint32(data, pos);
+        block.storedSize = readUint32(data, pos + 4);
+        block.mode = static_cast<unsigned char>(data[pos + 8]);
+        block.inputPos = pos + BLOCK_HEADER_SIZE;
+        block.outputPos = total;
+        // Размеры из заголовка блока не доверенные: LZ-последовательность разворачивается
+        // не более чем в ~255 раз, поэтому итоговый объём ограничен размером входных данных
+        if (block.rawSize > MAX_COMPRESSION_CHUNK_SIZE || block.storedSize > data.size() - block.inputPos ||
+            block.rawSize > (block.storedSize + 1) * 256 ||
+            (block.mode == BLOCK_STORED && block.storedSize != block.rawSize) ||
+            (block.mode != BLOCK_STORED && block.mode != BLOCK_LZ)) {
+            throw runtime_error("Повреждённые сжатые данные");
+        }
+        blocks.push_back(block);
+        pos = block.inputPos + block.storedSize;
+        total += block.rawSize;
+    }
+
+    string result(total, '\0');
+    parallelFor(blocks.size(), [&](size_t index) {
+        const Block& block = blocks[index];
+        char* dst = &result[0] + block.outputPos;
+        if (block.mode == BLOCK_STORED) {
+            memcpy(dst, data.data() + block.inputPos, block.rawSize);
+        } else {
+            lzDecompressBlock(data, block.inputPos, block.inputPos + block.storedSize, dst, block.rawSize);
+        }
+    }, tuningProfile().workerThreads);
+    return result;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+// Типы сжатия
+enum class CompressionType {
+    None = 0,
+    LZ = 1
+};
+
+// Наибольший допустимый размер блока (ограничивает память при распаковке повреждённых данных)
+const size_t MAX_COMPRESSION_CHUNK_SIZE = 64 << 20;
+
+// Сжатие и распаковка данных поблочно; блоки обрабатываются параллельно,
+// размер блока задаётся профилем производительности
+string compressData(const string& data, CompressionType type);
+string decompressData(const string& data, CompressionType type);
@@ -0,0 +1,94 @@
+#include "container.h"
+#include "checksum.h"
+#include "utils.h"
+
+// Сигнатура и версия формата. В версии 1 контрольная сумма исходных данных
+// хранилась в трейлере; файлы без контрольных сумм в обеих версиях совпадают
+static const char CONTAINER_MAGIC[] = "ERGR";
+static const uint8_t CONTAINER_VERSION = 2;
+
+// Формирование заголовка
+string writeContainerHeader(const ContainerHeader& header) {
+    string out(CONTAINER_MAGIC, 4);
+    out += static_cast<char>(CONTAINER_VERSION);
+    out += static_cast<char>(header.compression);
+    out += static_cast<char>(header.flags);
+    appendUint64(out, header.payloadSize);
+    return out;
+}
+
+// Проверка наличия заголовка в начале данных
+bool hasContainerHeader(const string& data) {
+    return data.size() >= CONTAINER_HEADER_SIZE && data.compare(0, 4, CONTAINER_MAGIC) == 0;
+}
+
+// Разбор заголовка
+ContainerHeader readContainerHeader(const string& data) {
+    if (!hasContainerHeader(data)) throw invalid_argument("Заголовок файла не найден");
+    uint8_t version = static_cast<uint8_t>(data[4]);
+    if (version != CONTAINER_VERSION && version != 1) {
+        throw invalid_argument("Неподдерживаемая версия формата файла");
+    }
+    ContainerHeader header;
+    uint8_t compression = static_cast<uint8_t>(data[5]);
+    if (compression > static_cast<uint8_t>(CompressionType::LZ)) {
+        throw invalid_argument("Неизвестный тип сжатия в заголовке");
+    }
+    header.compression = static_cast<CompressionType>(compression);
+    header.flags = static_cast<uint8_t>(data[6]);
+    if (header.flags & ~CONTAINER_FLAG_CHECKSUM) {
+        throw invalid_argument("Неизвестные флаги в заголовке");
+    }
+    if (version == 1 && (header.flags & CONTAINER_FLAG_CHECKSUM)) {
+        throw invalid_argument("Неподдерживаемая версия формата файла (контрольные суммы версии 1)");
+    }
+    header.payloadSize = readUint64(data, 7);
+    return header;
+}
+
+// Формирование трейлера
+string writeContainerTrailer(const ContainerTrailer& trailer) {
+    string out;
+    appendUint32(out, trailer.cipherChecksum);
+    return out;
+}
+
+// Разбор трейлера в конце данных
+ContainerTrailer readContainerTrailer(const string& data) {
+    if (data.size() < CONTAINER_HEADER_SIZE + CONTAINER_TRAILER_SIZE) {
+        throw invalid_argument("Трейлер файла не найден");
+    }
+    size_t pos = data.size() - CONTAINER_TRAILER_SIZE;
+    ContainerTrailer trailer;
+    trailer.cipherChecksum = readUint32(data, pos);
+    return trailer;
+}
+
+// Сжатие и контрольная сумма исходных данных
+string packPayload(const string& input, ContainerHeader& header) {
+    string payload;
+    if (header.compression != CompressionType::None) {
+        payload = compressData(input, header.compression);
+    } else {
+        payload.reserve(input.size() + PAYLOAD_CHECKSUM_SIZE);
+        payload.append(input);
+    }
+    if (header.flags & CONTAINER_FLAG_CHECKSUM) appendUint32(payload, crc32c(input));
+    header.payloadSize = payload.size();
+    return payload;
+}
+
+bool unpackPayload(string& payload, const ContainerHeader& header, string& output) {
+    // Шифр Плейфера отбрасывает завершающие нулевые байты — восстанавливаем исходный размер
+    payload.resize(header.payloadSize, '\0');
+    bool withChecksum = (header.flags & CONTAINER_FLAG_CHECKSUM) != 0;
+    uint32_t expected = 0;
+    if (withChecksum) {
+        if (payload.size() < PAYLOAD_CHECKSUM_SIZE) throw runtime_error("Повреждённые данные");
+        expected = readUint32(payload, payload.size() - PAYLOAD_CHECKSUM_SIZE);
+        payload.resize(payload.size() - PAYLOAD_CHECKSUM_SIZE);
+    }
+    if (header.compression == CompressionType::None) output = move(payload);
+    else output = decompressData(payload, header.compression);
+    return !withChecksum || crc32c(output) == expected;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "compression.h"
+
+using namespace std;
+
+// Заголовок выходного файла: записывается открытым текстом перед шифротекстом,
+// чтобы при расшифровании параметры обработки определялись автоматически
+struct ContainerHeader {
+    CompressionType compression = CompressionType::None;
+    uint8_t flags = 0;         // Набор CONTAINER_FLAG_*
+    uint64_t payloadSize = 0;  // Размер данных до шифрования (шифр Плейфера дополняет их)
+};
+
+// Размер заголовка в байтах
+const size_t CONTAINER_HEADER_SIZE = 15;
+
+// Контрольные суммы: CRC32C исходных данных дописывается к данным перед шифрованием,
+// в конце файла записан трейлер с CRC32C шифротекста
+const uint8_t CONTAINER_FLAG_CHECKSUM = 0x01;
+
+// Трейлер хранит только контрольную сумму шифротекста: сумма исходных данных
+// в открытом виде позволяла бы подбирать ключ без расшифрования всего файла
+struct ContainerTrailer {
+    uint32_t cipherChecksum = 0;
+};
+
+const size_t CONTAINER_TRAILER_SIZE = 4;
+
+// Размер контрольной суммы исходных данных в конце зашифрованной части
+const size_t PAYLOAD_CHECKSUM_SIZE = 4;
+
+string writeContainerHeader(const ContainerHeader& header);
+bool hasContainerHeader(const string& data);
+ContainerHeader readContainerHeader(const string& data);
+string writeContainerTrailer(const ContainerTrailer& trailer);
+ContainerTrailer readContainerTrailer(const string& data);
+
+// Подготовка данных к шифрованию по параметрам заголовка (сжатие, контрольная сумма);
+// размер результата записывается в header.payloadSize
+string packPayload(const string& input, ContainerHeader& header);
+// Обратное преобразование расшифрованных данных. Буфер payload используется повторно.
+// Исключение — если данные не распаковываются, false — если не совпала контрольная сумма
+bool unpackPayload(string& payload, const ContainerHeader& header, string& output);
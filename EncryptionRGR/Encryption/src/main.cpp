@@ -2,6 +2,7 @@
 #include <cstdint>
 #include <locale>
 #include <filesystem>
+#include <vector>
 #ifdef _WIN32
 #include <windows.h>
 #include "dynamic_loader.h"
@@ -9,10 +10,12 @@
 #include <dlfcn.h>
 #endif
 #include "utils.h"
-
-// Типы функций для шифрования/дешифрования
-using EncryptFunc = string(*)(const string&, const string&);
-using DecryptFunc = string(*)(const string&, const string&);
+#include "compression.h"
+#include "container.h"
+#include "checksum.h"
+#include "rotation.h"
+#include "batch.h"
+#include "tuning.h"
 
 // Указатели на функции шифров
 EncryptFunc caesarEncryptFunc = nullptr;
@@ -195,16 +198,16 @@ bool selectCipher(CipherType& selectedCipher) {
 // Выбор действия
 bool selectAction(ActionType& selectedAction) {
     string input;
-    cout << "Выберите действие:\n1. Зашифровать\n2. Расшифровать\nВаш выбор: ";
+    cout << "Выберите действие:\n1. Зашифровать\n2. Расшифровать\n3. Зашифровать для нескольких получателей\nВаш выбор: ";
     getline(cin, input);
 
     try {
         int choice = stoi(input);
-        if (choice == 1 || choice == 2) {
+        if (choice >= 1 && choice <= 3) {
             selectedAction = static_cast<ActionType>(choice);
             return true;
         } else {
-            cerr << "Ошибка: введите 1 или 2.\n";
+            cerr << "Ошибка: введите 1, 2 или 3.\n";
         }
     } catch (...) {
         cerr << "Ошибка: введите корректное число.\n";
@@ -239,7 +242,366 @@ bool getEncryptionKey(string& key, CipherType cipher) {
     return true;
 }
 
-int main() {
+// Применение выбранного шифра
+bool applyCipher(CipherType cipher, ActionType action, const string& input, const string& key, string& output) {
+    switch (cipher) {
+        case CipherType::Caesar:
+            if (!caesarEncryptFunc || !caesarDecryptFunc) {
+                cerr << "Ошибка: функции Цезаря недоступны.\n";
+                return false;
+            }
+            output = (action == ActionType::Encrypt)
+                ? caesarEncryptFunc(input, key)
+                : caesarDecryptFunc(input, key);
+            return true;
+        case CipherType::Playfair:
+            if (!playfairEncryptFunc || !playfairDecryptFunc) {
+                cerr << "Ошибка: функции Плейфера недоступны.\n";
+                return false;
+            }
+            output = (action == ActionType::Encrypt)
+                ? playfairEncryptFunc(input, key)
+                : playfairDecryptFunc(input, key);
+            return true;
+        case CipherType::Polybius:
+            if (!polybiusEncryptFunc || !polybiusDecryptFunc) {
+                cerr << "Ошибка: функции Полибия недоступны.\n";
+                return false;
+            }
+            output = (action == ActionType::Encrypt)
+                ? polybiusEncryptFunc(input, key)
+                : polybiusDecryptFunc(input, key);
+            return true;
+        default:
+            cerr << "Ошибка: неизвестный шифр.\n";
+            return false;
+    }
+}
+
+// Данные, подготовленные к шифрованию: сжатие и контрольная сумма
+// исходных данных вычисляются один раз и не зависят от шифра и ключа
+struct PreparedPayload {
+    ContainerHeader header;
+    bool useContainer = false;
+    string payload;
+};
+
+PreparedPayload preparePayload(const string& input, CompressionType compression, bool withChecksum) {
+    PreparedPayload prepared;
+    prepared.useContainer = (compression != CompressionType::None || withChecksum);
+    if (!prepared.useContainer) return prepared;
+    prepared.header.compression = compression;
+    prepared.header.flags = withChecksum ? CONTAINER_FLAG_CHECKSUM : 0;
+    prepared.payload = packPayload(input, prepared.header);
+    return prepared;
+}
+
+// Шифрование подготовленных данных. Если включена хотя бы одна опция,
+// перед шифротекстом пишется заголовок, а при контрольной сумме — трейлер после него
+bool encryptPrepared(CipherType cipher, const string& input, const PreparedPayload& prepared,
+                     const string& key, string& output) {
+    if (!prepared.useContainer) {
+        return applyCipher(cipher, ActionType::Encrypt, input, key, output);
+    }
+
+    string cipherText;
+    if (!applyCipher(cipher, ActionType::Encrypt, prepared.payload, key, cipherText)) return false;
+    // Результат собирается в заранее выделенном буфере без промежуточных копий шифротекста
+    output.clear();
+    output.reserve(CONTAINER_HEADER_SIZE + cipherText.size() + CONTAINER_TRAILER_SIZE);
+    output += writeContainerHeader(prepared.header);
+    output += cipherText;
+
+    if (prepared.header.flags & CONTAINER_FLAG_CHECKSUM) {
+        ContainerTrailer trailer;
+        trailer.cipherChecksum = crc32c(cipherText);
+        output += writeContainerTrailer(trailer);
+    }
+    return true;
+}
+
+// Шифрование с необязательным сжатием и контрольной суммой
+bool encryptData(CipherType cipher, const string& input, const string& key,
+                 CompressionType compression, bool withChecksum, string& output) {
+    PreparedPayload prepared = preparePayload(input, compression, withChecksum);
+    return encryptPrepared(cipher, input, prepared, key, output);
+}
+
+// Сообщение о несовпадении контрольной суммы расшифрованных данных
+const char* const WRONG_KEY_MESSAGE =
+    "Ошибка: контрольная сумма расшифрованных данных не совпадает (неверный ключ или шифр).\n";
+
+// Расшифровка шифром с перехватом ошибок плагина (например, некорректных координат Полибия)
+bool decryptCipherText(CipherType cipher, const string& input, const string& key, string& output) {
+    try {
+        return applyCipher(cipher, ActionType::Decrypt, input, key, output);
+    } catch (const exception& e) {
+        cerr << "Ошибка: не удалось расшифровать данные: " << e.what() << ".\n";
+        return false;
+    }
+}
+
+// Расшифрование; параметры сжатия и наличие контрольной суммы берутся из заголовка.
+// Входной буфер используется повторно: заголовок и трейлер удаляются из него на месте
+bool decryptData(CipherType cipher, string& input, const string& key, string& output) {
+    if (!hasContainerHeader(input)) {
+        return decryptCipherText(cipher, input, key, output);
+    }
+
+    ContainerHeader header;
+    ContainerTrailer trailer;
+    try {
+        header = readContainerHeader(input);
+        if (header.flags & CONTAINER_FLAG_CHECKSUM) trailer = readContainerTrailer(input);
+    } catch (const exception& e) {
+        cerr << "Ошибка: " << e.what() << ".\n";
+        return false;
+    }
+    bool withChecksum = (header.flags & CONTAINER_FLAG_CHECKSUM) != 0;
+    size_t cipherSize = input.size() - CONTAINER_HEADER_SIZE;
+    if (withChecksum) {
+        cipherSize -= CONTAINER_TRAILER_SIZE;
+        // Проверка шифротекста до расшифрования: отличает повреждение файла от неверного ключа
+        if (crc32cUpdate(0, input.data() + CONTAINER_HEADER_SIZE, cipherSize) != trailer.cipherChecksum) {
+            cerr << "Ошибка: файл повреждён (контрольная сумма шифротекста не совпадает).\n";
+            return false;
+        }
+    }
+    // Шифротекст не короче исходных данных ни у одного из шифров
+    if (header.payloadSize > cipherSize) {
+        cerr << "Ошибка: файл повреждён (некорректный размер данных в заголовке).\n";
+        return false;
+    }
+
+    input.resize(CONTAINER_HEADER_SIZE + cipherSize);
+    input.erase(0, CONTAINER_HEADER_SIZE);
+    string payload;
+    if (!decryptCipherText(cipher, input, key, payload)) return false;
+    bool checksumMatches = false;
+    try {
+        checksumMatches = unpackPayload(payload, header, output);
+    } catch (const exception&) {
+        // Шифротекст с контрольной суммой уже проверен, значит дело в ключе или шифре
+        if (withChecksum) cerr << WRONG_KEY_MESSAGE;
+        else cerr << "Ошибка: не удалось распаковать данные (неверный ключ, шифр или файл повреждён).\n";
+        return false;
+    }
+
+    if (!checksumMatches) {
+        cerr << WRONG_KEY_MESSAGE;
+        return false;
+    }
+    return true;
+}
+
+// Выбор сжатия перед шифрованием
+bool selectCompression(CompressionType& compression) {
+    int choice;
+    if (!getValidInt(choice, "Сжать данные перед шифрованием?\n1. Нет\n2. Да\nВаш выбор: ", 1, 2)) {
+        return false;
+    }
+    compression = (choice == 2) ? CompressionType::LZ : CompressionType::None;
+    return true;
+}
+
+// Выбор добавления контрольной суммы
+bool selectChecksum(bool& withChecksum) {
+    int choice;
+    if (!getValidInt(choice, "Добавить контрольную сумму для проверки при расшифровании?\n1. Нет\n2. Да\nВаш выбор: ", 1, 2)) {
+        return false;
+    }
+    withChecksum = (choice == 2);
+    return true;
+}
+
+// Запись результата в файл
+bool writeOutputFile(const string& filename, const string& data) {
+    ofstream outFile(filename, ios::binary);
+    if (!outFile) {
+        cerr << "Ошибка: не удалось создать файл '" << filename << "'.\n";
+        return false;
+    }
+    outFile << data;
+    outFile.close();
+    return true;
+}
+
+// Получатель при шифровании для нескольких получателей
+struct FanOutTarget {
+    CipherType cipher;
+    string key;
+};
+
+// Ввод дополнительных получателей (первый уже выбран в главном цикле)
+bool collectFanOutTargets(vector<FanOutTarget>& targets) {
+    int count;
+    if (!getValidInt(count, "Сколько ещё получателей? ", 1, 15)) {
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        cout << "\nПолучатель " << targets.size() + 1 << ":";
+        FanOutTarget target;
+        if (!selectCipher(target.cipher)) return false;
+        if (!getEncryptionKey(target.key, target.cipher)) return false;
+        targets.push_back(target);
+    }
+    return true;
+}
+
+// Шифрование одних данных для нескольких получателей: входные данные читаются один раз,
+// сжатие и контрольная сумма считаются один раз, затем каждый получатель
+// шифруется и записывается в свой файл в отдельном потоке
+void encryptFanOut(const string& input, const vector<FanOutTarget>& targets,
+                   CompressionType compression, bool withChecksum, bool isText) {
+    PreparedPayload prepared = preparePayload(input, compression, withChecksum);
+    vector<string> filenames(targets.size());
+    vector<char> written(targets.size(), 0);
+    vector<string> errors(targets.size());
+
+    // Ошибка одного получателя не мешает остальным
+    parallelFor(targets.size(), [&](size_t index) {
+        filenames[index] = "output_" + to_string(index + 1) + (isText ? ".txt" : ".bin");
+        try {
+            string output;
+            if (!encryptPrepared(targets[index].cipher, input, prepared, targets[index].key, output)) return;
+            written[index] = writeOutputFile(filenames[index], output);
+        } catch (const exception& e) {
+            errors[index] = e.what();
+        }
+    });
+
+    for (size_t i = 0; i < targets.size(); ++i) {
+        if (written[i]) {
+            cout << "Результат для получателя " << i + 1 << " сохранен в файл: " << filenames[i] << "\n";
+        } else if (!errors[i].empty()) {
+            cerr << "Ошибка: получатель " << i + 1 << ": " << errors[i] << "\n";
+        } else {
+            cerr << "Ошибка: результат для получателя " << i + 1 << " не сохранен.\n";
+        }
+    }
+    cout << "\n";
+}
+
+// Разбор названия шифра в командной строке
+bool parseCipherName(const string& name, CipherType& cipher) {
+    if (name == "caesar") cipher = CipherType::Caesar;
+    else if (name == "playfair") cipher = CipherType::Playfair;
+    else if (name == "polybius") cipher = CipherType::Polybius;
+    else {
+        cerr << "Ошибка: неизвестный шифр '" << name << "' (caesar, playfair, polybius).\n";
+        return false;
+    }
+    return true;
+}
+
+// Функции выбранного шифра
+void getCipherFunctions(CipherType cipher, EncryptFunc& encrypt, DecryptFunc& decrypt) {
+    switch (cipher) {
+        case CipherType::Caesar: encrypt = caesarEncryptFunc; decrypt = caesarDecryptFunc; break;
+        case CipherType::Playfair: encrypt = playfairEncryptFunc; decrypt = playfairDecryptFunc; break;
+        case CipherType::Polybius: encrypt = polybiusEncryptFunc; decrypt = polybiusDecryptFunc; break;
+        default: encrypt = nullptr; decrypt = nullptr; break;
+    }
+}
+
+void printUsage() {
+    cout << "Использование:\n"
+         << "  encryption                      интерактивный режим\n"
+         << "  encryption rotate <шифр> <старый ключ> <новый ключ> <файл>...\n"
+         << "                                  замена ключа в зашифрованных файлах; старый ключ проверяется\n"
+         << "                                  только у файлов с контрольной суммой (--checksum)\n"
+         << "  encryption batch <шифр> <ключ> <исходный каталог> <каталог результата> --key-label <метка>\n"
+         << "                   [--compress] [--checksum]\n"
+         << "                                  шифрование каталога; неизменённые с прошлого запуска файлы пропускаются\n"
+         << "  encryption calibrate            повторная калибровка профиля производительности\n";
+}
+
+// Замена ключа: шифротекст перешифровывается без записи открытого текста на диск
+int runRotateCommand(const vector<string>& args) {
+    if (args.size() < 5) {
+        printUsage();
+        return 1;
+    }
+    CipherType cipher;
+    if (!parseCipherName(args[1], cipher)) return 1;
+    const string& oldKey = args[2];
+    const string& newKey = args[3];
+    if (cipher == CipherType::Caesar && (!isNumericKeyValid(oldKey) || !isNumericKeyValid(newKey))) {
+        cerr << "Ошибка: ключ для шифра Цезаря должен содержать только цифры.\n";
+        return 1;
+    }
+
+    EncryptFunc encrypt;
+    DecryptFunc decrypt;
+    getCipherFunctions(cipher, encrypt, decrypt);
+    RotationMap map = buildRotationMap(cipher, encrypt, decrypt, oldKey, newKey);
+
+    vector<string> paths(args.begin() + 4, args.end());
+    size_t failed = rotateFiles(paths, map);
+    return failed == 0 ? 0 : 1;
+}
+
+// Пакетное шифрование каталога с манифестом в каталоге результата
+int runBatchCommand(const vector<string>& args) {
+    if (args.size() < 5) {
+        printUsage();
+        return 1;
+    }
+    CipherType cipher;
+    if (!parseCipherName(args[1], cipher)) return 1;
+    const string& key = args[2];
+    if (key.empty() || (cipher == CipherType::Caesar && !isNumericKeyValid(key))) {
+        cerr << "Ошибка: некорректный ключ.\n";
+        return 1;
+    }
+
+    CompressionType compression = CompressionType::None;
+    bool withChecksum = false;
+    string keyLabel;
+    for (size_t i = 5; i < args.size(); ++i) {
+        if (args[i] == "--compress") compression = CompressionType::LZ;
+        else if (args[i] == "--checksum") withChecksum = true;
+        else if (args[i] == "--key-label" && i + 1 < args.size()) keyLabel = args[++i];
+        else {
+            cerr << "Ошибка: неизвестный параметр '" << args[i] << "'.\n";
+            return 1;
+        }
+    }
+
+    // Метка отличает ключи в манифесте вместо отпечатка самого ключа,
+    // который для коротких ключей легко подобрать перебором
+    if (keyLabel.empty() || keyLabel.find_first_of(" \t\n") != string::npos) {
+        cerr << "Ошибка: укажите метку ключа без пробелов: --key-label <метка>.\n";
+        return 1;
+    }
+
+    // Параметры обработки входят в название шифра в манифесте: при их смене файлы шифруются заново
+    BatchOptions options;
+    options.cipherName = args[1] + (compression != CompressionType::None ? "+lz" : "") + (withChecksum ? "+crc" : "");
+    options.keyLabel = keyLabel;
+    options.sourceDir = args[3];
+    options.outputDir = args[4];
+    size_t failed = runIncrementalBatch(options, [&](const string& input, string& output) {
+        return encryptData(cipher, input, key, compression, withChecksum, output);
+    });
+    return failed == 0 ? 0 : 1;
+}
+
+// Выполнение команды из командной строки
+int runCommand(const vector<string>& args) {
+    try {
+        if (args[0] == "rotate") return runRotateCommand(args);
+        if (args[0] == "batch") return runBatchCommand(args);
+        if (args[0] == "calibrate") return calibrateTuningProfile() ? 0 : 1;
+    } catch (const exception& e) {
+        cerr << "Произошла ошибка: " << e.what() << "\n";
+        return 1;
+    }
+    printUsage();
+    return 1;
+}
+
+int main(int argc, char* argv[]) {
     try {
 #ifdef _WIN32
         SetConsoleOutputCP(CP_UTF8);
@@ -255,6 +617,10 @@ int main() {
             return 1;
         }
 
+        // Профиль производительности загружается только после входа: калибровка нагружает
+        // процессор и пишет файл в домашний каталог. При явной калибровке старый профиль не читается
+        if (argc < 2 || string(argv[1]) != "calibrate") loadTuningProfile();
+
         // Загрузка функций
         if (caesarAvailable) {
             caesarEncryptFunc =
@@ -299,6 +665,13 @@ int main() {
 #endif
         }
 
+        // Режим командной строки
+        if (argc > 1) {
+            int code = runCommand(vector<string>(argv + 1, argv + argc));
+            closeLibraries();
+            return code;
+        }
+
         // Главный цикл
         while (true) {
             string inputText, sourceFile, key;
@@ -314,48 +687,28 @@ int main() {
             if (shouldExit) break;
             if (!getEncryptionKey(key, selectedCipher)) continue;
 
-            string output;
-            switch (selectedCipher) {
-                case CipherType::Caesar:
-                    if (!caesarEncryptFunc || !caesarDecryptFunc) {
-                        cerr << "Ошибка: функции Цезаря недоступны.\n";
-                        continue;
-                    }
-                    output = (selectedAction == ActionType::Encrypt)
-                        ? caesarEncryptFunc(inputText, key)
-                        : caesarDecryptFunc(inputText, key);
-                    break;
-                case CipherType::Playfair:
-                    if (!playfairEncryptFunc || !playfairDecryptFunc) {
-                        cerr << "Ошибка: функции Плейфера недоступны.\n";
-                        continue;
-                    }
-                    output = (selectedAction == ActionType::Encrypt)
-                        ? playfairEncryptFunc(inputText, key)
-                        : playfairDecryptFunc(inputText, key);
-                    break;
-                case CipherType::Polybius:
-                    if (!polybiusEncryptFunc || !polybiusDecryptFunc) {
-                        cerr << "Ошибка: функции Полибия недоступны.\n";
-                        continue;
-                    }
-                    output = (selectedAction == ActionType::Encrypt)
-                        ? polybiusEncryptFunc(inputText, key)
-                        : polybiusDecryptFunc(inputText, key);
-                    break;
-                default:
-                    cerr << "Ошибка: неизвестный шифр.\n";
-                    continue;
+            CompressionType compression = CompressionType::None;
+            bool withChecksum = false;
+            if (selectedAction != ActionType::Decrypt) {
+                if (!selectCompression(compression)) continue;
+                if (!selectChecksum(withChecksum)) continue;
             }
 
-            string outputFilename = "output" + string(isText ? ".txt" : ".bin");
-            ofstream outFile(outputFilename, ios::binary);
-            if (!outFile) {
-                cerr << "Ошибка: не удалось создать файл '" << outputFilename << "'.\n";
+            if (selectedAction == ActionType::FanOut) {
+                vector<FanOutTarget> targets = {{selectedCipher, key}};
+                if (!collectFanOutTargets(targets)) continue;
+                encryptFanOut(inputText, targets, compression, withChecksum, isText);
                 continue;
             }
-            outFile << output;
-            outFile.close();
+
+            string output;
+            bool success = (selectedAction == ActionType::Encrypt)
+                ? encryptData(selectedCipher, inputText, key, compression, withChecksum, output)
+                : decryptData(selectedCipher, inputText, key, output);
+            if (!success) continue;
+
+            string outputFilename = "output" + string(isText ? ".txt" : ".bin");
+            if (!writeOutputFile(outputFilename, output)) continue;
             cout << "Результат сохранен в файл: " << outputFilename << "\n\n";
         }
 
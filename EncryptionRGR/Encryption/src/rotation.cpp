@@ -0,0 +1,227 @@
+#include "rotation.h"
+#include "container.h"
+#include "checksum.h"
+#include <cstdio>
+#include <filesystem>
+#include <set>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// Отметка недопустимой группы (например, координаты Полибия вне таблицы 16x16)
+static const uint32_t ROTATION_INVALID = 0xFFFFFFFF;
+
+// Построение таблицы: все возможные группы шифротекста расшифровываются старым ключом
+// и зашифровываются новым. Каждая группа обрабатывается шифром независимо, поэтому
+// композиция сводится к одной таблице подстановки
+RotationMap buildRotationMap(CipherType cipher, EncryptFunc encrypt, DecryptFunc decrypt,
+                             const string& oldKey, const string& newKey) {
+    if (!encrypt || !decrypt) throw runtime_error("Функции шифра недоступны");
+
+    RotationMap map;
+    map.decrypt = decrypt;
+    map.newKey = newKey;
+    if (cipher == CipherType::Caesar) {
+        // Сдвиг на разность ключей
+        string domain(256, '\0');
+        for (int i = 0; i < 256; ++i) domain[i] = static_cast<char>(i);
+        string rotated = encrypt(decrypt(domain, oldKey), newKey);
+        map.unitSize = 1;
+        map.table.resize(256);
+        for (int i = 0; i < 256; ++i) map.table[i] = static_cast<unsigned char>(rotated[i]);
+        return map;
+    }
+
+    map.unitSize = 2;
+    map.table.assign(1 << 16, ROTATION_INVALID);
+    string domain;
+    if (cipher == CipherType::Polybius) {
+        // Переназначение координат: допустимы только строка и столбец меньше 16
+        for (int row = 0; row < 16; ++row) {
+            for (int col = 0; col < 16; ++col) {
+                domain += static_cast<char>(row);
+                domain += static_cast<char>(col);
+            }
+        }
+    } else if (cipher == CipherType::Playfair) {
+        // Отображение биграмма -> биграмм по всем 65536 парам
+        domain.resize(2 << 16);
+        for (size_t i = 0; i < (1 << 16); ++i) {
+            domain[2 * i] = static_cast<char>(i >> 8);
+            domain[2 * i + 1] = static_cast<char>(i & 0xFF);
+        }
+    } else {
+        throw invalid_argument("Неизвестный шифр");
+    }
+
+    string plain = decrypt(domain, oldKey);
+    // Шифр Плейфера отбрасывает завершающие нулевые байты — восстанавливаем их
+    if (cipher == CipherType::Playfair) plain.resize(domain.size(), '\0');
+    string rotated = encrypt(plain, newKey);
+    if (rotated.size() != domain.size()) throw runtime_error("Не удалось построить таблицу перешифрования");
+
+    for (size_t i = 0; i < domain.size(); i += 2) {
+        uint32_t from = (static_cast<unsigned char>(domain[i]) << 8) | static_cast<unsigned char>(domain[i + 1]);
+        uint32_t to = (static_cast<unsigned char>(rotated[i]) << 8) | static_cast<unsigned char>(rotated[i + 1]);
+        map.table[from] = to;
+    }
+    return map;
+}
+
+// Применение таблицы к блоку шифротекста на месте
+static void applyRotation(const RotationMap& map, string& chunk) {
+    if (map.unitSize == 1) {
+        for (char& c : chunk) c = static_cast<char>(map.table[static_cast<unsigned char>(c)]);
+        return;
+    }
+    for (size_t i = 0; i + 1 < chunk.size(); i += 2) {
+        uint32_t from = (static_cast<unsigned char>(chunk[i]) << 8) | static_cast<unsigned char>(chunk[i + 1]);
+        uint32_t to = map.table[from];
+        if (to == ROTATION_INVALID) throw invalid_argument("Некорректные данные в шифротексте");
+        chunk[i] = static_cast<char>(to >> 8);
+        chunk[i + 1] = static_cast<char>(to & 0xFF);
+    }
+}
+
+static void writeAll(FILE* file, const string& data) {
+    if (fwrite(data.data(), 1, data.size(), file) != data.size()) {
+        throw runtime_error("Ошибка записи во временный файл");
+    }
+}
+
+// Проверка перешифрованных данных: контрольная сумма исходных данных находится внутри
+// шифротекста и совпадёт, только если старый ключ был верным
+static bool verifyRotated(const string& cipherText, const ContainerHeader& header, const RotationMap& map) {
+    try {
+        string payload = map.decrypt(cipherText, map.newKey);
+        string plain;
+        return unpackPayload(payload, header, plain);
+    } catch (const exception&) {
+        return false;
+    }
+}
+
+// Перешифрование файла. Данные обрабатываются блоками и пишутся во временный файл
+// рядом с исходным, который после сброса на диск атомарно заменяет исходный:
+// при сбое на диске остаётся либо старый, либо новый шифротекст, но не открытый текст.
+// Символическая ссылка разрешается: заменяется файл, на который она указывает
+void rotateFile(const string& path, const RotationMap& map) {
+    error_code ec;
+    filesystem::path target = filesystem::canonical(path, ec);
+    if (ec) throw runtime_error("Файл не найден");
+    ifstream in(target, ios::binary);
+    if (!in) throw runtime_error("Не удалось открыть файл");
+    uint64_t fileSize = filesystem::file_size(target);
+
+    // Границы шифротекста: заголовок и трейлер контейнера переписываются отдельно
+    string header(min<uint64_t>(fileSize, CONTAINER_HEADER_SIZE), '\0');
+    in.read(&header[0], header.size());
+    bool isContainer = hasContainerHeader(header);
+    bool withChecksum = false;
+    uint64_t cipherStart = 0, cipherEnd = fileSize;
+    ContainerHeader containerHeader;
+    ContainerTrailer trailer;
+    if (isContainer) {
+        containerHeader = readContainerHeader(header);
+        withChecksum = (containerHeader.flags & CONTAINER_FLAG_CHECKSUM) != 0;
+        cipherStart = CONTAINER_HEADER_SIZE;
+        if (withChecksum) {
+            if (fileSize < CONTAINER_HEADER_SIZE + CONTAINER_TRAILER_SIZE) throw runtime_error("Трейлер файла не найден");
+            cipherEnd = fileSize - CONTAINER_TRAILER_SIZE;
+            string tail(CONTAINER_TRAILER_SIZE, '\0');
+            in.seekg(cipherEnd);
+            in.read(&tail[0], tail.size());
+            trailer = readContainerTrailer(header + tail);
+        }
+    }
+    if ((cipherEnd - cipherStart) % map.unitSize != 0) {
+        throw invalid_argument("Некорректная длина шифротекста");
+    }
+
+    string tempPath = target.string() + ".rotate.tmp";
+    FILE* out = fopen(tempPath.c_str(), "wb");
+    if (!out) throw runtime_error("Не удалось создать временный файл");
+    try {
+        // Права доступа исходного файла переносятся сразу, до записи шифротекста
+        filesystem::permissions(tempPath, filesystem::status(target).permissions());
+        if (isContainer) writeAll(out, header);
+
+        uint32_t oldChecksum = 0, newChecksum = 0;
+        // Для проверки ключа новый шифротекст целиком сохраняется в памяти
+        string rotated;
+        if (withChecksum) rotated.reserve(cipherEnd - cipherStart);
+        in.seekg(cipherStart);
+        string chunk;
+        for (uint64_t pos = cipherStart; pos < cipherEnd; pos += chunk.size()) {
+            chunk.resize(min<uint64_t>(ROTATION_CHUNK_SIZE, cipherEnd - pos));
+            if (!in.read(&chunk[0], chunk.size())) throw runtime_error("Ошибка чтения файла");
+            if (withChecksum) oldChecksum = crc32cUpdate(oldChecksum, chunk.data(), chunk.size());
+            applyRotation(map, chunk);
+            if (withChecksum) {
+                newChecksum = crc32cUpdate(newChecksum, chunk.data(), chunk.size());
+                rotated += chunk;
+            }
+            writeAll(out, chunk);
+        }
+
+        if (withChecksum) {
+            if (oldChecksum != trailer.cipherChecksum) {
+                throw runtime_error("Файл повреждён (контрольная сумма шифротекста не совпадает)");
+            }
+            if (!verifyRotated(rotated, containerHeader, map)) {
+                throw runtime_error("Неверный старый ключ или шифр (контрольная сумма данных не совпадает)");
+            }
+            // Контрольная сумма исходных данных входит в шифротекст и перешифрована вместе с ним
+            trailer.cipherChecksum = newChecksum;
+            writeAll(out, writeContainerTrailer(trailer));
+        }
+
+        if (fflush(out) != 0) throw runtime_error("Ошибка записи во временный файл");
+#ifndef _WIN32
+        if (fsync(fileno(out)) != 0) throw runtime_error("Ошибка записи во временный файл");
+#endif
+    } catch (...) {
+        fclose(out);
+        remove(tempPath.c_str());
+        throw;
+    }
+    fclose(out);
+    in.close();
+    filesystem::rename(tempPath, target);
+}
+
+// Перешифрование набора файлов параллельно; возвращает число файлов с ошибками.
+// Повторы одного файла (в том числе через символические ссылки) отбрасываются:
+// иначе он был бы перешифрован дважды
+size_t rotateFiles(const vector<string>& paths, const RotationMap& map) {
+    vector<string> unique;
+    set<filesystem::path> seen;
+    for (const string& path : paths) {
+        error_code ec;
+        filesystem::path canonical = filesystem::canonical(path, ec);
+        // Несуществующий файл остаётся в списке, чтобы попасть в отчёт об ошибках
+        if (ec) canonical = filesystem::absolute(path).lexically_normal();
+        if (seen.insert(canonical).second) unique.push_back(path);
+    }
+
+    vector<string> errors(unique.size());
+    parallelFor(unique.size(), [&](size_t index) {
+        try {
+            rotateFile(unique[index], map);
+        } catch (const exception& e) {
+            errors[index] = e.what();
+        }
+    });
+
+    size_t failed = 0;
+    for (size_t i = 0; i < unique.size(); ++i) {
+        if (errors[i].empty()) {
+            cout << "Ключ заменён: " << unique[i] << "\n";
+        } else {
+            cerr << "Ошибка: " << unique[i] << ": " << errors[i] << "\n";
+            ++failed;
+        }
+    }
+    cout << "Обработано файлов: " << unique.size() - failed << " из " << unique.size() << "\n";
+    return failed;
+}
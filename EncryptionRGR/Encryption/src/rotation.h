@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "utils.h"
+
+using namespace std;
+
+// Таблица перешифрования: отображение группы байтов шифротекста под старым ключом
+// в группу байтов под новым ключом (Цезарь — по байту, Плейфер и Полибий — по паре байтов)
+struct RotationMap {
+    size_t unitSize = 1;
+    vector<uint32_t> table;
+    // Проверка результата расшифрованием новым ключом (для файлов с контрольной суммой)
+    DecryptFunc decrypt = nullptr;
+    string newKey;
+};
+
+// Размер блока при потоковой перезаписи файла (кратен размеру группы)
+const size_t ROTATION_CHUNK_SIZE = 1 << 20;
+
+RotationMap buildRotationMap(CipherType cipher, EncryptFunc encrypt, DecryptFunc decrypt,
+                             const string& oldKey, const string& newKey);
+void rotateFile(const string& path, const RotationMap& map);
+size_t rotateFiles(const vector<string>& paths, const RotationMap& map);
@@ -0,0 +1,210 @@
+#include "tuning.h"
+#include "checksum.h"
+#include "compression.h"
+#include "utils.h"
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <vector>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+// Версия формата файла профиля
+static const int PROFILE_VERSION = 1;
+
+// Объём тестовых данных для калибровки
+static const size_t CALIBRATION_DATA_SIZE = 8 << 20;
+
+TuningProfile& tuningProfile() {
+    static TuningProfile profile;
+    return profile;
+}
+
+static string hostName() {
+#ifdef _WIN32
+    const char* name = getenv("COMPUTERNAME");
+    return name ? name : "localhost";
+#else
+    char name[256] = {};
+    if (gethostname(name, sizeof(name) - 1) != 0 || name[0] == '\0') return "localhost";
+    return name;
+#endif
+}
+
+string tuningProfilePath() {
+#ifdef _WIN32
+    const char* home = getenv("USERPROFILE");
+#else
+    const char* home = getenv("HOME");
+#endif
+    string dir = (home && *home) ? string(home) + "/" : string("./");
+    return dir + ".encryption_profile_" + hostName();
+}
+
+// Чтение профиля; false, если файла нет или он некорректен
+static bool readProfile(const string& path, TuningProfile& profile) {
+    ifstream in(path);
+    if (!in) return false;
+
+    int version = 0;
+    unsigned long threads = 0;
+    bool hasChunk = false, hasThreads = false, hasCrc = false;
+    string line;
+    while (getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        size_t eq = line.find('=');
+        if (eq == string::npos) continue;
+        string name = line.substr(0, eq);
+        string value = line.substr(eq + 1);
+        try {
+            if (name == "version") version = stoi(value);
+            else if (name == "chunk_size") { profile.compressionChunkSize = stoul(value); hasChunk = true; }
+            else if (name == "threads") { threads = stoul(value); hasThreads = true; }
+            else if (name == "hardware_crc") { profile.hardwareCrc = (value == "1"); hasCrc = true; }
+        } catch (...) {
+            return false;
+        }
+    }
+    // Число потоков ограничивается числом ядер этой машины; 0 — все ядра
+    unsigned maxThreads = thread::hardware_concurrency();
+    if (maxThreads == 0) maxThreads = 1;
+    profile.workerThreads = (threads == 0) ? 0 : static_cast<unsigned>(min<unsigned long>(threads, maxThreads));
+
+    return version == PROFILE_VERSION && hasChunk && hasThreads && hasCrc &&
+           profile.compressionChunkSize >= 4096 && profile.compressionChunkSize <= MAX_COMPRESSION_CHUNK_SIZE;
+}
+
+// Временный файл рядом с профилем; имя уникально, чтобы одновременные запуски не мешали друг другу
+static string profileTempPath(const string& path) {
+    random_device rd;
+    return path + ".tmp" + to_string(rd());
+}
+
+// Запись профиля во временный файл и замена старого профиля переименованием
+static bool writeProfile(ofstream& out, const string& tempPath, const string& path, const TuningProfile& profile) {
+    out << "# Профиль производительности (encryption calibrate — повторная калибровка)\n"
+        << "version=" << PROFILE_VERSION << "\n"
+        << "chunk_size=" << profile.compressionChunkSize << "\n"
+        << "threads=" << profile.workerThreads << "\n"
+        << "hardware_crc=" << (profile.hardwareCrc ? 1 : 0) << "\n";
+    out.close();
+    error_code ec;
+    if (out) filesystem::rename(tempPath, path, ec);
+    if (!out || ec) {
+        filesystem::remove(tempPath, ec);
+        cerr << "Ошибка: не удалось сохранить профиль производительности '" << path << "'.\n";
+        return false;
+    }
+    return true;
+}
+
+// Тестовые данные, похожие на журналы: сжимаемые, но не тривиально
+static string makeCalibrationData() {
+    mt19937 gen(12345);
+    uniform_int_distribution<> dis(0, 99999);
+    string data;
+    data.reserve(CALIBRATION_DATA_SIZE + 128);
+    while (data.size() < CALIBRATION_DATA_SIZE) {
+        data += "{\"id\":" + to_string(dis(gen)) + ",\"level\":\"info\",\"msg\":\"request processed\",\"ms\":" +
+                to_string(dis(gen) % 1000) + "}\n";
+    }
+    data.resize(CALIBRATION_DATA_SIZE);
+    return data;
+}
+
+// Лучшее из нескольких измерений, в секундах
+template <typename Body>
+static double measure(Body body, int repeats = 2) {
+    double best = 1e30;
+    for (int i = 0; i < repeats; ++i) {
+        auto start = chrono::steady_clock::now();
+        body();
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        best = min(best, elapsed.count());
+    }
+    return best;
+}
+
+// Калибровка: короткие замеры каждого доступного варианта
+static TuningProfile calibrate() {
+    cout << "Калибровка производительности...\n";
+    TuningProfile& profile = tuningProfile();
+    string data = makeCalibrationData();
+
+    // CRC32C: аппаратный или табличный вариант
+    profile.hardwareCrc = false;
+    if (crc32cHardwareAvailable()) {
+        double software = measure([&] { crc32c(data); });
+        profile.hardwareCrc = true;
+        double hardware = measure([&] { crc32c(data); });
+        profile.hardwareCrc = hardware <= software;
+    }
+
+    // Размер блока и число потоков подбираются совместно: от размера блока зависит,
+    // сколько потоков реально получат работу
+    unsigned maxThreads = thread::hardware_concurrency();
+    if (maxThreads == 0) maxThreads = 1;
+    vector<unsigned> threadCounts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    TuningProfile best = profile;
+    double bestTime = 1e30;
+    size_t bestBlocks = 1;
+    for (size_t chunkSize : {size_t(256) << 10, size_t(1) << 20, size_t(4) << 20}) {
+        size_t blocks = (CALIBRATION_DATA_SIZE + chunkSize - 1) / chunkSize;
+        for (unsigned threads : threadCounts) {
+            profile.compressionChunkSize = chunkSize;
+            profile.workerThreads = threads;
+            double elapsed = measure([&] { decompressData(compressData(data, CompressionType::LZ), CompressionType::LZ); });
+            if (elapsed < bestTime) {
+                bestTime = elapsed;
+                best = profile;
+                bestBlocks = blocks;
+            }
+        }
+    }
+    // Тестовые данные дают работу не более чем bestBlocks потокам: если победил наибольший
+    // проверяемый вариант, большие файлы выиграют и от остальных ядер
+    if (best.workerThreads >= min<size_t>(bestBlocks, maxThreads)) best.workerThreads = 0;
+    profile = best;
+
+    cout << "Выбрано: блок сжатия " << (profile.compressionChunkSize >> 10) << " КиБ, потоков сжатия ";
+    if (profile.workerThreads == 0) cout << "все ядра";
+    else cout << profile.workerThreads;
+    cout << ", CRC32C " << (profile.hardwareCrc ? "аппаратный" : "программный") << "\n";
+    return profile;
+}
+
+void loadTuningProfile() {
+    string path = tuningProfilePath();
+    TuningProfile loaded;
+    if (readProfile(path, loaded)) {
+        tuningProfile() = loaded;
+        return;
+    }
+    // Если профиль нельзя сохранить, калибровка повторялась бы при каждом запуске
+    string tempPath = profileTempPath(path);
+    ofstream out(tempPath, ios::trunc);
+    if (!out) {
+        cerr << "Предупреждение: профиль производительности '" << path
+             << "' нельзя сохранить, используются параметры по умолчанию.\n";
+        return;
+    }
+    writeProfile(out, tempPath, path, calibrate());
+}
+
+bool calibrateTuningProfile() {
+    tuningProfile() = TuningProfile();
+    string path = tuningProfilePath();
+    string tempPath = profileTempPath(path);
+    ofstream out(tempPath, ios::trunc);
+    if (!out) {
+        cerr << "Ошибка: не удалось сохранить профиль производительности '" << path << "'.\n";
+        return false;
+    }
+    if (!writeProfile(out, tempPath, path, calibrate())) return false;
+    cout << "Профиль сохранён: " << path << "\n";
+    return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+// Параметры производительности, подобранные для конкретной машины
+struct TuningProfile {
+    size_t compressionChunkSize = 1 << 20;  // Размер блока сжатия
+    unsigned workerThreads = 0;             // Число потоков сжатия (0 — по числу ядер)
+    bool hardwareCrc = true;                // Аппаратный CRC32C, если поддерживается
+};
+
+// Текущий профиль (по умолчанию — значения выше)
+TuningProfile& tuningProfile();
+
+// Путь к файлу профиля этой машины
+string tuningProfilePath();
+
+// Загрузка профиля после входа пользователя; при первом запуске на машине выполняется
+// калибровка (если профиль некуда сохранить — используются значения по умолчанию)
+void loadTuningProfile();
+
+// Принудительная калибровка с сохранением профиля; false, если профиль не сохранён
+bool calibrateTuningProfile();
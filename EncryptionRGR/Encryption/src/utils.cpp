@@ -1,4 +1,8 @@
 #include "utils.h"
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <vector>
 
 // Безопасный ввод числа
 bool safeInputInt(int& var, const string& errorMsg) {
@@ -39,3 +43,79 @@ bool isNumericKeyValid(const string& key) {
     }
     return !key.empty();
 }
+
+// Запись 32-битного числа (little-endian)
+void appendUint32(string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+// Запись 64-битного числа (little-endian)
+void appendUint64(string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+// Чтение 32-битного числа (little-endian)
+uint32_t readUint32(const string& data, size_t pos) {
+    if (pos + 4 > data.size()) throw runtime_error("Неожиданный конец данных");
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(data[pos + i])) << (8 * i);
+    }
+    return value;
+}
+
+// Чтение 64-битного числа (little-endian)
+uint64_t readUint64(const string& data, size_t pos) {
+    if (pos + 8 > data.size()) throw runtime_error("Неожиданный конец данных");
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(data[pos + i])) << (8 * i);
+    }
+    return value;
+}
+
+// Число рабочих потоков для заданного числа задач
+unsigned workerCount(size_t tasks, unsigned maxThreads) {
+    unsigned hw = maxThreads;
+    if (hw == 0) hw = thread::hardware_concurrency();
+    if (hw == 0) hw = 1;
+    return static_cast<unsigned>(min<size_t>(hw, max<size_t>(tasks, 1)));
+}
+
+// Признак рабочего потока parallelFor: вложенные циклы выполняются в нём последовательно,
+// чтобы число потоков не росло квадратично
+static thread_local bool insideParallelFor = false;
+
+// Параллельный цикл: задачи раздаются потокам по одной, первая ошибка пробрасывается
+void parallelFor(size_t count, const function<void(size_t)>& body, unsigned maxThreads) {
+    unsigned threads = insideParallelFor ? 1 : workerCount(count, maxThreads);
+    if (threads <= 1) {
+        for (size_t i = 0; i < count; ++i) body(i);
+        return;
+    }
+
+    atomic<size_t> next(0);
+    exception_ptr error;
+    mutex errorMutex;
+    vector<thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            insideParallelFor = true;
+            size_t i;
+            while ((i = next++) < count) {
+                try {
+                    body(i);
+                } catch (...) {
+                    lock_guard<mutex> lock(errorMutex);
+                    if (!error) error = current_exception();
+                }
+            }
+        });
+    }
+    for (thread& worker : workers) worker.join();
+    if (error) rethrow_exception(error);
+}
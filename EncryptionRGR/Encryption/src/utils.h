@@ -5,6 +5,9 @@
 #include <limits>
 #include <random>
 #include <string>
+#include <cstdint>
+#include <stdexcept>
+#include <functional>
 
 using namespace std;
 
@@ -18,11 +21,27 @@ enum class CipherType {
 // Типы действий
 enum class ActionType {
     Encrypt = 1,
-    Decrypt = 2
+    Decrypt = 2,
+    FanOut = 3     // Шифрование одних данных для нескольких получателей
 };
 
+// Типы функций для шифрования/дешифрования
+using EncryptFunc = string(*)(const string&, const string&);
+using DecryptFunc = string(*)(const string&, const string&);
+
 // Безопасный ввод
 bool safeInputInt(int& var, const string& errorMsg);
 void pauseBeforeExit();
 string generateRandomNumericKey();
 bool isNumericKeyValid(const string& key);
+
+// Запись и чтение целых чисел в порядке little-endian
+void appendUint32(string& out, uint32_t value);
+void appendUint64(string& out, uint64_t value);
+uint32_t readUint32(const string& data, size_t pos);
+uint64_t readUint64(const string& data, size_t pos);
+
+// Параллельное выполнение body(i) для i из [0, count);
+// maxThreads ограничивает число потоков (0 — по числу ядер)
+unsigned workerCount(size_t tasks, unsigned maxThreads = 0);
+void parallelFor(size_t count, const function<void(size_t)>& body, unsigned maxThreads = 0);